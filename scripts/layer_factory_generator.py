@@ -637,6 +637,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkNegotiateLoaderLayerInterfaceVe
         self.layer_factory += '        virtual void PostCallApiFunction(const char *api_name) {};\n'
         self.layer_factory += '        virtual void PreCallApiFunction(const char *api_name, VkResult result) {};\n'
         self.layer_factory += '        virtual void PostCallApiFunction(const char *api_name, VkResult result) {};\n'
+        self.layer_factory += '        // vkCmd* hooks also pass the command buffer being recorded\n'
+        self.layer_factory += '        virtual void PreCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name) { PreCallApiFunction(api_name); };\n'
+        self.layer_factory += '        virtual void PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name) { PostCallApiFunction(api_name); };\n'
+        self.layer_factory += '        virtual void PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name, VkResult result) { PostCallApiFunction(api_name, result); };\n'
         self.layer_factory += '\n'
         self.layer_factory += '        // Pre/post hook point declarations\n'
     #
@@ -745,7 +749,10 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkNegotiateLoaderLayerInterfaceVe
         default_def = return_map[return_type]
         result = result.replace(';', default_def, 1)
         pre_call = result.replace("VKAPI_PTR *PFN_vk", "PreCall")
-        pre_call_function = '{ PreCallApiFunction("%s");' % name
+        if name.startswith('vkCmd'):
+            pre_call_function = '{ PreCallApiFunction(commandBuffer, "%s");' % name
+        else:
+            pre_call_function = '{ PreCallApiFunction("%s");' % name
         pre_call = pre_call.replace("{", pre_call_function)
         post_call = pre_call.replace("PreCall", "PostCall")
         if return_type == 'VkResult':
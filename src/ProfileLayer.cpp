@@ -21,6 +21,7 @@
 #include <sstream>
 #include <algorithm>
 #include <queue>
+#include <string.h>
 
 using namespace std;
 
@@ -60,8 +61,14 @@ void Profiler::DumpLog(const char *format, ...)
     vsnprintf(buffer, sizeof(buffer), format, ap);
     va_end(ap);
 
+    DumpLogString(buffer);
+}
+
+// Unformatted variant of DumpLog for lines that may not fit its fixed buffer
+void Profiler::DumpLogString(const char *str)
+{
     //m_logMutex.lock();
-    m_ssLog << buffer;
+    m_ssLog << str;
     if ((m_ssLog.gcount() >= 1 * 1024 * 1024) ||
         ((m_nFrame % display_rate) == 0))
     {
@@ -70,7 +77,7 @@ void Profiler::DumpLog(const char *format, ...)
         m_ssLog.str(std::string());
     }
     //m_logMutex.unlock();
-    printf("[VkLayer_PROFILE_LAYER] - %s", buffer);
+    printf("[VkLayer_PROFILE_LAYER] - %s", str);
 }
 
 // ms
@@ -118,6 +125,11 @@ void Profiler::UpdateFps(void)
         m_cpuTimeSum += time;
         m_cpuTimeList[m_cpuTimeIndex] = time;
 
+        if (m_optionFlag & PL_OPTION_RECORD_SUMMARY)
+        {
+            m_frameTimes.push_back(time * 1000);
+        }
+
         if (m_optionFlag & PL_OPTION_PRINT_FPS)
         {
             DumpLog("\nFrame Num = %d\n", m_nFrame);
@@ -182,12 +194,96 @@ void  Profiler::ProcessCmdFifo()
         case 'I':
             m_optionFlag = m_optionFlag & (~PL_OPTION_PRINT_PROFILE_INFO_ALL);
             break;
+        case 'J':
+            m_optionFlag |= PL_OPTION_PRINT_LABEL_INFO;
+            break;
+        case 'K':
+            m_optionFlag = m_optionFlag & (~PL_OPTION_PRINT_LABEL_INFO);
+            break;
+        case 'L':
+            m_optionFlag |= PL_OPTION_RECORD_SUMMARY;
+            break;
+        case 'M':
+            m_optionFlag = m_optionFlag & (~PL_OPTION_RECORD_SUMMARY);
+            break;
         default:
             break;
         }
     }
 }
 
+// Write the run summary next to the dump log, named after the executable and process so runs don't overwrite each other
+void Profiler::WriteSummary()
+{
+    // Partial data or a process that never presented, e.g. vulkaninfo, gives no useful summary
+    if (!(m_optionFlag & PL_OPTION_RECORD_SUMMARY) || m_frameTimes.empty())
+    {
+        return;
+    }
+
+    char  exePath[1024];
+    char* pExeName = exePath;
+    RunSummary summary;
+
+    InitRunSummary(&summary);
+    if (GetExecutableName(exePath, &pExeName, sizeof(exePath)) == PL_Success)
+    {
+        summary.executable = pExeName;
+    }
+    summary.processId    = GetIdOfCurrentProcess();
+    summary.memPeakSize  = peak_memory_;
+    summary.memPeakCount = peak_mem_objects_;
+    {
+        std::lock_guard<std::mutex> lock(m_apiMutex);
+        summary.apiMap   = m_apiRunMap;
+    }
+    ComputeFrameTimeStats(&m_frameTimes, &summary);
+
+    char fileName[1280];
+#ifdef _WIN32
+    snprintf(fileName, sizeof(fileName), "VkProfileSummary_%s_%u.txt", summary.executable.c_str(), summary.processId);
+#else
+    snprintf(fileName, sizeof(fileName), "/tmp/VkProfileSummary_%s_%u.txt", summary.executable.c_str(), summary.processId);
+#endif
+
+    if (WriteRunSummary(fileName, summary) == PL_Success)
+    {
+        DumpLog("\n[INFO] - run summary written to %s\n", fileName);
+    }
+    else
+    {
+        DumpLog("\n[ERROR] - write run summary %s error!\n", fileName);
+    }
+    m_logFile << m_ssLog.str();
+    m_ssLog.str(std::string());
+}
+
+// Only calls between the first and the last present go into the run totals, so one-time setup and
+// teardown calls don't skew the per-frame numbers of runs with different lengths
+void Profiler::UpdateRunSummary()
+{
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+
+    if ((m_optionFlag & PL_OPTION_RECORD_SUMMARY) && (m_nFrame > 0))
+    {
+        for (auto it = m_apiFrameMap.begin(); it != m_apiFrameMap.end(); ++it)
+        {
+            if (it->second.callCount > 0)
+            {
+                ApiSummary& data = m_apiRunMap[it->first];
+                data.time += it->second.time;
+                data.callCount += it->second.callCount;
+            }
+        }
+    }
+
+    // Reset in place rather than clear, so the recording path doesn't allocate again every frame
+    for (auto it = m_apiFrameMap.begin(); it != m_apiFrameMap.end(); ++it)
+    {
+        it->second = { 0.0, 0 };
+    }
+}
+
 static bool CompFunc(const std::pair<std::string, CallData>& i, const std::pair<std::string, CallData>& j)
 {
     return (i.second.time > j.second.time);
@@ -198,6 +294,8 @@ void Profiler::UpdateProfileInfo()
     if (m_optionFlag & PL_OPTION_PRINT_PROFILE_INFO)
     {
         DumpLog("\nProfiling Data, Frame %d\n", m_nFrame);
+
+        std::lock_guard<std::mutex> lock(m_apiMutex);
         
         std::vector<std::pair<std::string, CallData>> vec;
         //std::priority_queue<CallData, std::vector<CallData>, std::function<bool(CallData&, CallData&)>> pq(CompFunc);
@@ -231,6 +329,167 @@ void Profiler::UpdateProfileInfo()
     }
 }
 
+// Print a node and, depth first, all regions nested inside it
+void Profiler::DumpLabelNode(uint32 index, float totalTime)
+{
+    const LabelData& data = m_labelNodes[index].self;
+    if (data.cmdCount > 0)
+    {
+        // Paths of deeply nested regions can exceed the DumpLog buffer
+        char values[128];
+        snprintf(values, sizeof(values), ",%.4f,%.2f%%,%d,%d\n", data.time,
+                 data.time*100/totalTime, data.cmdCount, data.drawCount);
+        DumpLogString((m_labelNodes[index].path + values).c_str());
+    }
+
+    for (auto it = m_labelNodes[index].children.begin(); it != m_labelNodes[index].children.end(); ++it)
+    {
+        DumpLabelNode(it->second, totalTime);
+    }
+}
+
+void Profiler::UpdateLabelInfo()
+{
+    std::lock_guard<std::mutex> lock(m_labelMutex);
+
+    if (m_optionFlag & PL_OPTION_PRINT_LABEL_INFO)
+    {
+        float totalTime = 0.000001f;
+        uint32 totalCmds = 0;
+        for (auto it = m_labelNodes.begin(); it != m_labelNodes.end(); ++it)
+        {
+            totalTime += it->self.time;
+            totalCmds += it->self.cmdCount;
+        }
+
+        if (totalCmds > 0)
+        {
+            // Folded "Frame;Pass;SubPass" paths with self values, so nested regions are not counted twice
+            DumpLog("\n--------------------------------------------------------------\n");
+            DumpLog("\nLabel Regions: Frame %d, Total Recording Time %.4f\n", m_nFrame, totalTime);
+            DumpLog("Path,SelfTime,Percentage,SelfCmdCount,SelfDrawCount\n");
+            DumpLabelNode(0, totalTime);
+            DumpLog("\n");
+        }
+    }
+
+    for (auto it = m_labelNodes.begin(); it != m_labelNodes.end(); ++it)
+    {
+        it->self = { 0.0f, 0, 0 };
+    }
+}
+
+// Attribute a recorded command to the innermost open label region of its command buffer
+void Profiler::RecordLabelCmd(VkCommandBuffer commandBuffer, const char *api_name, float time)
+{
+    if (commandBuffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    bool isDraw = (strncmp(api_name, "vkCmdDraw", 9) == 0);
+
+    std::lock_guard<std::mutex> lock(m_labelMutex);
+    uint32 index = 0;
+    auto it = m_cmdLabelStacks.find(commandBuffer);
+    if ((it != m_cmdLabelStacks.end()) && !it->second.empty())
+    {
+        index = it->second.back();
+    }
+
+    LabelData& data = m_labelNodes[index].self;
+    data.time += time;
+    data.cmdCount++;
+    if (isDraw)
+    {
+        data.drawCount++;
+    }
+}
+
+// Resolve the region node once here so recording a command is a single counter update
+void Profiler::BeginLabel(VkCommandBuffer commandBuffer, const char *pLabelName)
+{
+    std::string name((pLabelName != nullptr) ? pLabelName : "Unnamed");
+    // ';' separates tree levels and ',' CSV columns in the dump
+    std::replace(name.begin(), name.end(), ';', '_');
+    std::replace(name.begin(), name.end(), ',', '_');
+
+    std::lock_guard<std::mutex> lock(m_labelMutex);
+    std::vector<uint32>& stack = m_cmdLabelStacks[commandBuffer];
+    uint32 parent = stack.empty() ? 0 : stack.back();
+
+    auto it = m_labelNodes[parent].children.find(name);
+    if (it != m_labelNodes[parent].children.end())
+    {
+        stack.push_back(it->second);
+    }
+    else if (m_labelNodes.size() >= PL_MAX_LABEL_NODES)
+    {
+        // Labels with per-object or per-frame names would grow the tree without bound,
+        // fold regions past the limit into their parent
+        stack.push_back(parent);
+    }
+    else
+    {
+        uint32 index = static_cast<uint32>(m_labelNodes.size());
+        LabelNode node;
+        node.path = m_labelNodes[parent].path + ";" + name;
+        node.self = { 0.0f, 0, 0 };
+        m_labelNodes.push_back(node);
+        m_labelNodes[parent].children[name] = index;
+        stack.push_back(index);
+    }
+}
+
+void Profiler::EndLabel(VkCommandBuffer commandBuffer)
+{
+    std::lock_guard<std::mutex> lock(m_labelMutex);
+    auto it = m_cmdLabelStacks.find(commandBuffer);
+    if ((it != m_cmdLabelStacks.end()) && !it->second.empty())
+    {
+        it->second.pop_back();
+    }
+}
+
+void Profiler::RecordApiCall(VkCommandBuffer commandBuffer, const char *api_name)
+{
+    if (m_optionFlag & (PL_OPTION_PRINT_PROFILE_INFO | PL_OPTION_PRINT_LABEL_INFO | PL_OPTION_RECORD_SUMMARY))
+    {
+        float time = PostTime(api_name);
+
+        if (m_optionFlag & PL_OPTION_PRINT_PROFILE_INFO)
+        {
+            std::lock_guard<std::mutex> lock(m_apiMutex);
+            std::string name = std::string(api_name);
+            CallData data = { 0.0f, 0 };
+            auto it = m_apiCallMap.find(name);
+            if (it != m_apiCallMap.end())
+            {
+                data = it->second;
+            }
+
+            data.time += time;
+            data.callCount++;
+
+            m_apiCallMap[name] = data;
+        }
+
+        if (m_optionFlag & PL_OPTION_PRINT_LABEL_INFO)
+        {
+            RecordLabelCmd(commandBuffer, api_name, time);
+        }
+
+        if (m_optionFlag & PL_OPTION_RECORD_SUMMARY)
+        {
+            // Keyed by the generated string literal, so after the first call this neither allocates nor compares strings
+            std::lock_guard<std::mutex> lock(m_apiMutex);
+            ApiSummary& data = m_apiFrameMap[api_name];
+            data.time += time;
+            data.callCount++;
+        }
+    }
+}
+
 // This function will be called for every API call
 void Profiler::PreCallApiFunction(const char *api_name)
 {
@@ -239,44 +498,122 @@ void Profiler::PreCallApiFunction(const char *api_name)
         DumpLog("Calling %s\n", api_name);
     }
 
-    if (m_optionFlag & PL_OPTION_PRINT_PROFILE_INFO)
+    if (m_optionFlag & (PL_OPTION_PRINT_PROFILE_INFO | PL_OPTION_PRINT_LABEL_INFO | PL_OPTION_RECORD_SUMMARY))
     {
         PreTime(api_name);
     }
 }
 
+// Called after API calls without a VkResult
+void Profiler::PostCallApiFunction(const char *api_name)
+{
+    PostCallApiFunction(VK_NULL_HANDLE, api_name);
+}
+
 void Profiler::PostCallApiFunction(const char *api_name, VkResult result)
+{
+    PostCallApiFunction(VK_NULL_HANDLE, api_name, result);
+}
+
+// vkCmd* calls, attributed to the label regions of the command buffer they record into
+void Profiler::PreCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name)
+{
+    PreCallApiFunction(api_name);
+}
+
+void Profiler::PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name)
+{
+    if (m_optionFlag & PL_OPTION_PRINT_API_NAME)
+    {
+        DumpLog("Called %s\n", api_name);
+    }
+
+    RecordApiCall(commandBuffer, api_name);
+}
+
+void Profiler::PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name, VkResult result)
 {
     if (m_optionFlag & PL_OPTION_PRINT_API_NAME)
     {
         DumpLog("Called %s, result = %d\n", api_name, result);
     }
 
-    if (m_optionFlag & PL_OPTION_PRINT_PROFILE_INFO)
+    RecordApiCall(commandBuffer, api_name);
+}
+
+// Track the label stack of each command buffer. Overriding these hooks replaces the default
+// implementation, so the Pre/PostCallApiFunction calls have to be made here as well.
+VkResult Profiler::PreCallBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo)
+{
     {
-        float time = PostTime(api_name);
+        std::lock_guard<std::mutex> lock(m_labelMutex);
+        m_cmdLabelStacks[commandBuffer].clear();
+    }
+    PreCallApiFunction("vkBeginCommandBuffer");
+    return VK_SUCCESS;
+}
+
+VkResult Profiler::PreCallResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_labelMutex);
+        m_cmdLabelStacks.erase(commandBuffer);
+    }
+    PreCallApiFunction("vkResetCommandBuffer");
+    return VK_SUCCESS;
+}
 
-        std::string name = std::string(api_name);
-        CallData data = { 0.0f, 0 };
-        auto it = m_apiCallMap.find(name);
-        if (it != m_apiCallMap.end())
+void Profiler::PreCallFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount,
+                                         const VkCommandBuffer *pCommandBuffers)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_labelMutex);
+        for (uint32 i = 0; i < commandBufferCount; i++)
         {
-            data = it->second;
+            m_cmdLabelStacks.erase(pCommandBuffers[i]);
         }
+    }
+    PreCallApiFunction("vkFreeCommandBuffers");
+}
 
-        data.time += time;
-        data.callCount++;
+// The region is opened before the begin command and closed after the end command,
+// so both marker commands are counted inside their own region.
+void Profiler::PreCallCmdDebugMarkerBeginEXT(VkCommandBuffer commandBuffer, const VkDebugMarkerMarkerInfoEXT *pMarkerInfo)
+{
+    BeginLabel(commandBuffer, pMarkerInfo->pMarkerName);
+    PreCallApiFunction(commandBuffer, "vkCmdDebugMarkerBeginEXT");
+}
 
-        m_apiCallMap[name] = data;
-    }
+void Profiler::PostCallCmdDebugMarkerEndEXT(VkCommandBuffer commandBuffer)
+{
+    PostCallApiFunction(commandBuffer, "vkCmdDebugMarkerEndEXT");
+    EndLabel(commandBuffer);
+}
+
+void Profiler::PreCallCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT *pLabelInfo)
+{
+    BeginLabel(commandBuffer, pLabelInfo->pLabelName);
+    PreCallApiFunction(commandBuffer, "vkCmdBeginDebugUtilsLabelEXT");
+}
+
+void Profiler::PostCallCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer)
+{
+    PostCallApiFunction(commandBuffer, "vkCmdEndDebugUtilsLabelEXT");
+    EndLabel(commandBuffer);
 }
 
 // Intercept the memory allocation calls and increment the counter
 VkResult Profiler::PostCallAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
                                          const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory, VkResult result) {
+    PostCallApiFunction("vkAllocateMemory", result);
+    if (result != VK_SUCCESS) {
+        return VK_SUCCESS;
+    }
     number_mem_objects_++;
     total_memory_ += pAllocateInfo->allocationSize;
     mem_size_map_[*pMemory] = pAllocateInfo->allocationSize;
+    peak_mem_objects_ = max(peak_mem_objects_, number_mem_objects_);
+    peak_memory_ = max(peak_memory_, total_memory_);
     return VK_SUCCESS;
 }
 
@@ -287,6 +624,7 @@ void Profiler::PreCallFreeMemory(VkDevice device, VkDeviceMemory memory, const V
         VkDeviceSize this_alloc = mem_size_map_[memory];
         total_memory_ -= this_alloc;
     }
+    PreCallApiFunction("vkFreeMemory");
 }
 
 VkResult Profiler::PreCallQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo) {
@@ -314,10 +652,17 @@ VkResult Profiler::PreCallQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR
         DumpLog("Demo layer: %s\n", message.str().c_str());
     }
 
+    UpdateRunSummary();
+
     UpdateFps();
 
     UpdateProfileInfo();
 
+    UpdateLabelInfo();
+
+    // Start timing after the per-frame bookkeeping so only the present itself is measured
+    PreCallApiFunction("vkQueuePresentKHR");
+
     return VK_SUCCESS;
 }
 
@@ -23,20 +23,26 @@
 #include <sys/stat.h>
 #include <unordered_map>
 #include <map>
+#include <vector>
+#include <string>
 #include <fstream>
 #include <mutex>
 #include "vulkan/vulkan.h"
 #include "vk_layer_logging.h"
 #include "layer_factory.h"
 #include "Util.h"
+#include "ProfileSummary.h"
 
 #define TimeCount 40
+#define PL_MAX_LABEL_NODES 1024
 
 #define PL_OPTION_PRINT_API_NAME    0x1
 #define PL_OPTION_PRINT_FPS         0x2
 #define PL_OPTION_PRINT_DEBUG_INFO  0x4
 #define PL_OPTION_PRINT_PROFILE_INFO  0x8
 #define PL_OPTION_PRINT_PROFILE_INFO_ALL 0x16
+#define PL_OPTION_PRINT_LABEL_INFO  0x20
+#define PL_OPTION_RECORD_SUMMARY    0x40
 
 #define FIFO_NAME   "/tmp/VKProfileLayerCmd.fifo"
 
@@ -46,10 +52,27 @@ typedef struct CallData
     uint32  callCount;
 }CallData;
 
+// Commands recorded directly inside a debug marker / debug utils label region, excluding nested regions.
+typedef struct LabelData
+{
+    float   time;           // CPU time spent recording the commands, ms
+    uint32  cmdCount;       // Number of vkCmd* calls recorded
+    uint32  drawCount;      // Number of vkCmdDraw* calls recorded
+}LabelData;
+
+// Node of the label region tree. Nodes live for the whole run so command buffers can keep their
+// indices across frames; only the counters are reset at present.
+typedef struct LabelNode
+{
+    std::string                     path;       // Folded "Frame;Pass;SubPass" path
+    LabelData                       self;
+    std::map<std::string, uint32>   children;   // Child node index by label name
+}LabelNode;
+
 class Profiler : public layer_factory {
    public:
     // Constructor for state_tracker
-    Profiler() : number_mem_objects_(0), total_memory_(0), present_count_(0)
+    Profiler() : number_mem_objects_(0), total_memory_(0), present_count_(0), peak_mem_objects_(0), peak_memory_(0)
     {
         m_performanceCounters[NumQuery] = { 0 };
         m_cpuTimeSamples = 0;                        // Number of valid entried in m_cpuTimeList
@@ -58,10 +81,16 @@ class Profiler : public layer_factory {
         m_nFrame = 0;
         m_optionFlag = 0;
         m_optionFlag |= PL_OPTION_PRINT_FPS;
+        m_optionFlag |= PL_OPTION_RECORD_SUMMARY;
 
         memset(&m_cpuTimeList[0], 0, sizeof(m_cpuTimeList));
         m_frequency = (float)(GetPerfFrequency());
 
+        // Root of the label tree, holds commands recorded outside any region
+        m_labelNodes.resize(1);
+        m_labelNodes[0].path = "Frame";
+        m_labelNodes[0].self = { 0.0f, 0, 0 };
+
 #ifdef _WIN32
         m_logFile.open("DumpLogFile.txt", std::fstream::out | std::fstream::trunc);
 #else
@@ -78,6 +107,7 @@ class Profiler : public layer_factory {
 
     ~Profiler()
     {
+        WriteSummary();
         if (m_fifoFd != -1)
         {
             close(m_fifoFd);
@@ -86,7 +116,21 @@ class Profiler : public layer_factory {
     }
 
     void PreCallApiFunction(const char *api_name);
+    void PostCallApiFunction(const char *api_name);
     void PostCallApiFunction(const char *api_name, VkResult result);
+    void PreCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name);
+    void PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name);
+    void PostCallApiFunction(VkCommandBuffer commandBuffer, const char *api_name, VkResult result);
+
+    VkResult PreCallBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo);
+    VkResult PreCallResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags);
+    void PreCallFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount,
+                                   const VkCommandBuffer *pCommandBuffers);
+
+    void PreCallCmdDebugMarkerBeginEXT(VkCommandBuffer commandBuffer, const VkDebugMarkerMarkerInfoEXT *pMarkerInfo);
+    void PostCallCmdDebugMarkerEndEXT(VkCommandBuffer commandBuffer);
+    void PreCallCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT *pLabelInfo);
+    void PostCallCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer);
 
     VkResult PostCallAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo,
                                     const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory, VkResult result);
@@ -97,12 +141,21 @@ class Profiler : public layer_factory {
 
    private:
     void  DumpLog(const char *format, ...);
+    void  DumpLogString(const char *str);
     int64 BeginCpuTime(void);
     float EndCpuTime(int64 beginTime, const char * pDumpStr);
     float GetFramesPerSecond(void);
     void  UpdateFps(void);
     void  UpdateProfileInfo(void);
+    void  UpdateLabelInfo(void);
+    void  DumpLabelNode(uint32 index, float totalTime);
+    void  RecordApiCall(VkCommandBuffer commandBuffer, const char *api_name);
+    void  RecordLabelCmd(VkCommandBuffer commandBuffer, const char *api_name, float time);
+    void  BeginLabel(VkCommandBuffer commandBuffer, const char *pLabelName);
+    void  EndLabel(VkCommandBuffer commandBuffer);
     void  ProcessCmdFifo();
+    void  UpdateRunSummary();
+    void  WriteSummary();
     void  OutDebugInfo(const char* str)
     {
         if (m_optionFlag & PL_OPTION_PRINT_DEBUG_INFO)
@@ -159,11 +212,22 @@ class Profiler : public layer_factory {
     static thread_local int64 m_timeAPI;
 
     std::map<std::string, CallData> m_apiCallMap;
+    std::mutex          m_apiMutex;                                  // Guards the API maps, hooks run on any thread
     int32       m_fifoFd;
     uint32_t number_mem_objects_;
     VkDeviceSize total_memory_;
     uint32_t present_count_;
     std::unordered_map<VkDeviceMemory, VkDeviceSize> mem_size_map_;
+    uint32_t peak_mem_objects_;
+    VkDeviceSize peak_memory_;
+
+    std::vector<float>  m_frameTimes;                                // Every frame time of the run, ms
+    std::unordered_map<const char*, ApiSummary> m_apiFrameMap;       // Per-API totals since the last present
+    std::map<std::string, ApiSummary> m_apiRunMap;                   // Per-API totals between the first and last present
+
+    std::unordered_map<VkCommandBuffer, std::vector<uint32>> m_cmdLabelStacks;  // Open label nodes per command buffer
+    std::vector<LabelNode> m_labelNodes;                                        // Label tree, index 0 is the root
+    std::mutex          m_labelMutex;
 
     enum QueryTime
     {
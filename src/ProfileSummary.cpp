@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "ProfileSummary.h"
+
+void InitRunSummary(RunSummary* pSummary)
+{
+    pSummary->version      = PL_SUMMARY_VERSION;
+    pSummary->executable   = std::string();
+    pSummary->processId    = 0;
+    pSummary->frameCount   = 0;
+    pSummary->frameTimeAvg = 0.0f;
+    pSummary->frameTimeP50 = 0.0f;
+    pSummary->frameTimeP90 = 0.0f;
+    pSummary->frameTimeP95 = 0.0f;
+    pSummary->frameTimeP99 = 0.0f;
+    pSummary->frameTimeMax = 0.0f;
+    pSummary->memPeakSize  = 0;
+    pSummary->memPeakCount = 0;
+    pSummary->apiMap.clear();
+}
+
+// Nearest-rank percentile of a sorted list
+static float Percentile(const std::vector<float>& sorted, uint32 percent)
+{
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[(rank > 0) ? (rank - 1) : 0];
+}
+
+// Sorts pFrameTimes in place
+void ComputeFrameTimeStats(std::vector<float>* pFrameTimes, RunSummary* pSummary)
+{
+    pSummary->frameCount = static_cast<uint32>(pFrameTimes->size());
+    if (pFrameTimes->empty())
+    {
+        return;
+    }
+
+    std::sort(pFrameTimes->begin(), pFrameTimes->end());
+
+    double sum = 0.0;
+    for (auto it = pFrameTimes->begin(); it != pFrameTimes->end(); ++it)
+    {
+        sum += *it;
+    }
+
+    pSummary->frameTimeAvg = static_cast<float>(sum / pFrameTimes->size());
+    pSummary->frameTimeP50 = Percentile(*pFrameTimes, 50);
+    pSummary->frameTimeP90 = Percentile(*pFrameTimes, 90);
+    pSummary->frameTimeP95 = Percentile(*pFrameTimes, 95);
+    pSummary->frameTimeP99 = Percentile(*pFrameTimes, 99);
+    pSummary->frameTimeMax = pFrameTimes->back();
+}
+
+// One "key,value" pair per line, per-API data as "api,Name,Time,CallCount"
+Result WriteRunSummary(const char* pFileName, const RunSummary& summary)
+{
+    std::ofstream file(pFileName, std::ofstream::out | std::ofstream::trunc);
+    if (!file.is_open())
+    {
+        return PL_Error;
+    }
+
+    file << "# VkLayer_PROFILE_LAYER run summary\n";
+    file << "version," << summary.version << "\n";
+    file << "executable," << summary.executable << "\n";
+    file << "pid," << summary.processId << "\n";
+    file << "frames," << summary.frameCount << "\n";
+    file << "frametime_avg," << summary.frameTimeAvg << "\n";
+    file << "frametime_p50," << summary.frameTimeP50 << "\n";
+    file << "frametime_p90," << summary.frameTimeP90 << "\n";
+    file << "frametime_p95," << summary.frameTimeP95 << "\n";
+    file << "frametime_p99," << summary.frameTimeP99 << "\n";
+    file << "frametime_max," << summary.frameTimeMax << "\n";
+    file << "mem_peak_size," << summary.memPeakSize << "\n";
+    file << "mem_peak_count," << summary.memPeakCount << "\n";
+    for (auto it = summary.apiMap.begin(); it != summary.apiMap.end(); ++it)
+    {
+        file << "api," << it->first << "," << it->second.time << "," << it->second.callCount << "\n";
+    }
+
+    return file.good() ? PL_Success : PL_Error;
+}
+
+Result LoadRunSummary(const char* pFileName, RunSummary* pSummary)
+{
+    std::ifstream file(pFileName);
+    if (!file.is_open())
+    {
+        return PL_Error;
+    }
+
+    InitRunSummary(pSummary);
+    pSummary->version = 0;
+
+    // Every metric has to be present, a truncated file must not pass as all zeros
+    const char* mandatoryKeys[] =
+    {
+        "frames", "frametime_avg", "frametime_p50", "frametime_p90", "frametime_p95", "frametime_p99",
+        "frametime_max", "mem_peak_size", "mem_peak_count"
+    };
+    const uint32 numMandatoryKeys = sizeof(mandatoryKeys) / sizeof(mandatoryKeys[0]);
+    bool found[numMandatoryKeys] = {};
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || (line[0] == '#'))
+        {
+            continue;
+        }
+
+        size_t comma = line.find(',');
+        if (comma == std::string::npos)
+        {
+            return PL_Error;
+        }
+        std::string key   = line.substr(0, comma);
+        std::string value = line.substr(comma + 1);
+
+        for (uint32 i = 0; i < numMandatoryKeys; i++)
+        {
+            if (key == mandatoryKeys[i])
+            {
+                found[i] = true;
+            }
+        }
+
+        if (key == "version")
+        {
+            pSummary->version = strtoul(value.c_str(), nullptr, 10);
+            if ((pSummary->version == 0) || (pSummary->version > PL_SUMMARY_VERSION))
+            {
+                return PL_Error;
+            }
+        }
+        else if (key == "executable")     { pSummary->executable   = value; }
+        else if (key == "pid")            { pSummary->processId    = strtoul(value.c_str(), nullptr, 10); }
+        else if (key == "frames")         { pSummary->frameCount   = strtoul(value.c_str(), nullptr, 10); }
+        else if (key == "frametime_avg")  { pSummary->frameTimeAvg = strtof(value.c_str(), nullptr); }
+        else if (key == "frametime_p50")  { pSummary->frameTimeP50 = strtof(value.c_str(), nullptr); }
+        else if (key == "frametime_p90")  { pSummary->frameTimeP90 = strtof(value.c_str(), nullptr); }
+        else if (key == "frametime_p95")  { pSummary->frameTimeP95 = strtof(value.c_str(), nullptr); }
+        else if (key == "frametime_p99")  { pSummary->frameTimeP99 = strtof(value.c_str(), nullptr); }
+        else if (key == "frametime_max")  { pSummary->frameTimeMax = strtof(value.c_str(), nullptr); }
+        else if (key == "mem_peak_size")  { pSummary->memPeakSize  = strtoull(value.c_str(), nullptr, 10); }
+        else if (key == "mem_peak_count") { pSummary->memPeakCount = strtoul(value.c_str(), nullptr, 10); }
+        else if (key == "api")
+        {
+            std::stringstream ss(value);
+            std::string name, time, count;
+            if (!std::getline(ss, name, ',') || !std::getline(ss, time, ',') || !std::getline(ss, count, ','))
+            {
+                return PL_Error;
+            }
+            ApiSummary data = { strtod(time.c_str(), nullptr), strtoull(count.c_str(), nullptr, 10) };
+            pSummary->apiMap[name] = data;
+        }
+        // Unknown keys are skipped so older tools can read summaries with additional fields
+    }
+
+    if (pSummary->version == 0)
+    {
+        return PL_Error;
+    }
+    for (uint32 i = 0; i < numMandatoryKeys; i++)
+    {
+        if (!found[i])
+        {
+            return PL_Error;
+        }
+    }
+    return PL_Success;
+}
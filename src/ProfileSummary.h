@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include "Util.h"
+
+// Bump on incompatible layout changes only; new keys can be added without a bump since readers
+// skip unknown keys. LoadRunSummary rejects newer versions.
+#define PL_SUMMARY_VERSION 1
+
+typedef struct ApiSummary
+{
+    double  time;           // Total CPU time over the run, ms
+    uint64  callCount;
+}ApiSummary;
+
+// Per-run summary written by the layer when it is unloaded and read back by ProfileCompare.
+typedef struct RunSummary
+{
+    uint32          version;
+    std::string     executable;
+    uint32          processId;
+
+    uint32          frameCount;
+    float           frameTimeAvg;                       // Frame times, ms
+    float           frameTimeP50;
+    float           frameTimeP90;
+    float           frameTimeP95;
+    float           frameTimeP99;
+    float           frameTimeMax;
+
+    uint64          memPeakSize;                        // High-water mark of live device memory, bytes
+    uint32          memPeakCount;                       // High-water mark of live allocations
+
+    std::map<std::string, ApiSummary> apiMap;          // Calls between the first and the last present
+}RunSummary;
+
+void   InitRunSummary(RunSummary* pSummary);
+void   ComputeFrameTimeStats(std::vector<float>* pFrameTimes, RunSummary* pSummary);
+Result WriteRunSummary(const char* pFileName, const RunSummary& summary);
+Result LoadRunSummary(const char* pFileName, RunSummary* pSummary);
@@ -0,0 +1,208 @@
+/*
+ * Compare run summaries written by VkLayer_PROFILE_LAYER and fail on performance regressions.
+ *
+ * Usage: ProfileCompare [options] <baseline> <run> [<run> ...]
+ *
+ * Every run is compared against the baseline. Frame time percentiles, per-API time and call count
+ * per frame and memory high-water marks are reported; the exit code is 1 if any of them regressed
+ * beyond its threshold, 2 on usage or load errors or runs without frames and 0 otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "ProfileSummary.h"
+
+typedef struct Thresholds
+{
+    float   frameTime;      // Allowed frame time percentile increase, percent
+    float   apiTime;        // Allowed per-frame API time increase, percent
+    float   apiCount;       // Allowed per-frame API call count increase, percent; negative disables the check
+    float   apiMinTime;     // APIs below this per-frame time in both runs are not gated, ms
+    float   memory;         // Allowed memory high-water mark increase, percent
+}Thresholds;
+
+static void PrintUsage(const char* pName)
+{
+    printf("Usage: %s [options] <baseline> <run> [<run> ...]\n", pName);
+    printf("  -f <pct>   frame time percentile threshold (default 5)\n");
+    printf("  -a <pct>   per-frame API time threshold (default 10)\n");
+    printf("  -c <pct>   per-frame API call count threshold (default off)\n");
+    printf("  -t <ms>    ignore APIs cheaper than this per frame (default 0.01)\n");
+    printf("  -m <pct>   memory high-water mark threshold (default 5)\n");
+    printf("  -v         list every API, not only the regressed ones\n");
+}
+
+// Parse a non-negative threshold, the whole argument has to be a number
+static bool ParseThreshold(const char* pArg, float* pValue)
+{
+    char* pEnd = nullptr;
+    float value = strtof(pArg, &pEnd);
+    if ((pEnd == pArg) || (*pEnd != '\0') || !(value >= 0.0f) || (value > 1e9f))
+    {
+        return false;
+    }
+    *pValue = value;
+    return true;
+}
+
+static float Change(double base, double run)
+{
+    if (base <= 0.0)
+    {
+        return (run > 0.0) ? 100.0f : 0.0f;
+    }
+    return static_cast<float>((run - base) * 100.0 / base);
+}
+
+// Print one metric line and return whether it regressed
+static bool CompareValue(const char* pName, double base, double run, float threshold)
+{
+    float change = Change(base, run);
+    bool regressed = (threshold >= 0.0f) && (change > threshold);
+
+    printf("  %-24s %14.4f %14.4f %+9.2f%%%s\n", pName, base, run, change, regressed ? "  REGRESSION" : "");
+    return regressed;
+}
+
+static bool CompareRuns(const RunSummary& base, const RunSummary& run, const Thresholds& thresholds, bool verbose)
+{
+    bool regressed = false;
+
+    printf("\n%s (pid %u, %u frames) vs baseline %s (pid %u, %u frames)\n",
+           run.executable.c_str(), run.processId, run.frameCount,
+           base.executable.c_str(), base.processId, base.frameCount);
+    printf("  %-24s %14s %14s %10s\n", "Metric", "Baseline", "Run", "Change");
+
+    regressed |= CompareValue("frametime_avg", base.frameTimeAvg, run.frameTimeAvg, thresholds.frameTime);
+    regressed |= CompareValue("frametime_p50", base.frameTimeP50, run.frameTimeP50, thresholds.frameTime);
+    regressed |= CompareValue("frametime_p90", base.frameTimeP90, run.frameTimeP90, thresholds.frameTime);
+    regressed |= CompareValue("frametime_p95", base.frameTimeP95, run.frameTimeP95, thresholds.frameTime);
+    regressed |= CompareValue("frametime_p99", base.frameTimeP99, run.frameTimeP99, thresholds.frameTime);
+    // The single slowest frame is too noisy to gate on
+    CompareValue("frametime_max", base.frameTimeMax, run.frameTimeMax, -1.0f);
+    regressed |= CompareValue("mem_peak_size", static_cast<double>(base.memPeakSize),
+                              static_cast<double>(run.memPeakSize), thresholds.memory);
+    regressed |= CompareValue("mem_peak_count", base.memPeakCount, run.memPeakCount, thresholds.memory);
+
+    // Runs differ in length, so API data is compared per frame
+    double baseFrames = (base.frameCount > 0) ? base.frameCount : 1;
+    double runFrames  = (run.frameCount > 0) ? run.frameCount : 1;
+
+    std::map<std::string, bool> names;
+    for (auto it = base.apiMap.begin(); it != base.apiMap.end(); ++it)
+    {
+        names[it->first] = true;
+    }
+    for (auto it = run.apiMap.begin(); it != run.apiMap.end(); ++it)
+    {
+        names[it->first] = true;
+    }
+
+    printf("\n  %-40s %12s %12s %10s %10s %10s\n", "API (per frame)", "BaseTime", "RunTime", "Change", "BaseCount", "RunCount");
+    for (auto it = names.begin(); it != names.end(); ++it)
+    {
+        ApiSummary baseData = { 0.0, 0 };
+        ApiSummary runData  = { 0.0, 0 };
+        auto baseIt = base.apiMap.find(it->first);
+        auto runIt  = run.apiMap.find(it->first);
+        if (baseIt != base.apiMap.end())
+        {
+            baseData = baseIt->second;
+        }
+        if (runIt != run.apiMap.end())
+        {
+            runData = runIt->second;
+        }
+
+        double baseTime  = baseData.time / baseFrames;
+        double runTime   = runData.time / runFrames;
+        double baseCount = baseData.callCount / baseFrames;
+        double runCount  = runData.callCount / runFrames;
+
+        bool apiRegressed = false;
+        if ((baseTime >= thresholds.apiMinTime) || (runTime >= thresholds.apiMinTime))
+        {
+            apiRegressed |= (Change(baseTime, runTime) > thresholds.apiTime);
+            apiRegressed |= (thresholds.apiCount >= 0.0f) && (Change(baseCount, runCount) > thresholds.apiCount);
+        }
+
+        if (verbose || apiRegressed)
+        {
+            printf("  %-40s %12.4f %12.4f %+9.2f%% %10.2f %10.2f%s\n", it->first.c_str(), baseTime, runTime,
+                   Change(baseTime, runTime), baseCount, runCount, apiRegressed ? "  REGRESSION" : "");
+        }
+        regressed |= apiRegressed;
+    }
+
+    printf("\n  Result: %s\n", regressed ? "REGRESSED" : "OK");
+    return regressed;
+}
+
+int main(int argc, char** argv)
+{
+    Thresholds thresholds = { 5.0f, 10.0f, -1.0f, 0.01f, 5.0f };
+    bool verbose = false;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        float* pValue = nullptr;
+        if (strcmp(argv[i], "-f") == 0)      { pValue = &thresholds.frameTime; }
+        else if (strcmp(argv[i], "-a") == 0) { pValue = &thresholds.apiTime; }
+        else if (strcmp(argv[i], "-c") == 0) { pValue = &thresholds.apiCount; }
+        else if (strcmp(argv[i], "-t") == 0) { pValue = &thresholds.apiMinTime; }
+        else if (strcmp(argv[i], "-m") == 0) { pValue = &thresholds.memory; }
+        else if (strcmp(argv[i], "-v") == 0) { verbose = true; continue; }
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+            continue;
+        }
+
+        if ((++i >= argc) || !ParseThreshold(argv[i], pValue))
+        {
+            fprintf(stderr, "[ERROR] - invalid threshold for %s\n", argv[i - 1]);
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (files.size() < 2)
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<RunSummary> summaries(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (LoadRunSummary(files[i], &summaries[i]) != PL_Success)
+        {
+            fprintf(stderr, "[ERROR] - load run summary %s error!\n", files[i]);
+            return 2;
+        }
+        // A run that never presented can't be compared, fail the gate instead of passing it
+        if (summaries[i].frameCount == 0)
+        {
+            fprintf(stderr, "[ERROR] - run summary %s has no frames!\n", files[i]);
+            return 2;
+        }
+    }
+
+    bool regressed = false;
+    for (size_t i = 1; i < summaries.size(); i++)
+    {
+        regressed |= CompareRuns(summaries[0], summaries[i], thresholds, verbose);
+    }
+
+    return regressed ? 1 : 0;
+}